@@ -0,0 +1,317 @@
+#
+# Writes LineBreakTest.txt into LINE_BREAK_DIR, in the format of the Unicode
+# file, for when the one of the UCD version in use can't be downloaded. The
+# Line_Break and East_Asian_Width values are read from LineBreak.txt and
+# EastAsianWidth.txt in LINE_BREAK_DIR, and the rest from UCD. The breaks come from the rules of UAX #14 for Unicode 13.0.0,
+# applied one by one to the whole text as the Unicode tools do, with the
+# regular expression form of LB25 from example 7 of section 8.2. This is on
+# purpose independent of the state machine which gen_tables.py builds from the
+# same rules.
+#
+# Usage: python3 gen_line_break_test.py UCD LINE_BREAK_DIR
+#
+
+import sys
+import re
+
+MaxCode = 0x0010FFFF
+
+#------------------------------------------------------------------------------
+# Character data
+#------------------------------------------------------------------------------
+
+def getRangeValues(path, default):
+    values = [default] * (MaxCode + 1)
+    r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)")
+    for line in open(path):
+        m = r.match(line)
+        if m:
+            first = int(m.group(1), 16)
+            last = int(m.group(2), 16) if m.group(2) else first
+            for cp in range(first, last + 1):
+                values[cp] = m.group(3)
+    return values
+
+def getUnicodeData(ucd):
+    names = {}
+    categories = ['Cn'] * (MaxCode + 1)
+    first = None
+    for line in open(ucd + '/UnicodeData.txt'):
+        fields = line.split(';')
+        cp = int(fields[0], 16)
+        if fields[1].endswith(', First>'):
+            first = cp
+        elif fields[1].endswith(', Last>'):
+            for i in range(first, cp + 1):
+                categories[i] = fields[2]
+                names[i] = fields[1][1:-7].upper() + '-%04X' % i
+        else:
+            categories[cp] = fields[2]
+            names[cp] = fields[1]
+            if fields[1] == '<control>':
+                names[cp] = '<%s>' % (fields[10] or 'control-%04X' % cp)
+    return names, categories
+
+#------------------------------------------------------------------------------
+# Rules
+#------------------------------------------------------------------------------
+
+# LB1, with the default resolutions.
+def resolve(lb, gc):
+    if lb in ('AI', 'SG', 'XX'):
+        return 'AL'
+    if lb == 'SA':
+        return 'CM' if gc in ('Mn', 'Mc') else 'AL'
+    if lb == 'CJ':
+        return 'NS'
+    return lb
+
+HardBreaks = ('BK', 'CR', 'LF', 'NL')
+
+# Returns the rule which decides the break before `chars[i]`, and whether
+# there is a break, 'Mandatory' for LB4 and LB5. Each of `chars` is a tuple of
+# the resolved class, whether it is East Asian, and whether it is an
+# unassigned Extended_Pictographic code point.
+def lineBreakAt(chars, i):
+    raw = [c[0] for c in chars]
+    lp, rp = raw[i - 1], raw[i]
+
+    if lp == 'BK':
+        return ('4.0', 'Mandatory')
+    if lp == 'CR' and rp == 'LF':
+        return ('5.01', False)
+    if lp in ('CR', 'LF', 'NL'):
+        return ('5.02', 'Mandatory')
+    if rp in HardBreaks:
+        return ('6.0', False)
+    if rp in ('SP', 'ZW'):
+        return ('7.01', False)
+    j = i - 1
+    while j > 0 and raw[j] == 'SP':
+        j -= 1
+    if raw[j] == 'ZW':
+        return ('8.0', True)
+    if lp == 'ZWJ':
+        return ('8.1', False)
+    if rp in ('CM', 'ZWJ') and lp not in HardBreaks + ('SP', 'ZW'):
+        return ('9.0', False)
+
+    # LB9 and LB10: each code point which isn't attached to the one before it
+    # starts a unit of the class of that code point, or AL for CM and ZWJ.
+    units = []
+    for k, c in enumerate(chars):
+        if k > 0 and c[0] in ('CM', 'ZWJ') and \
+           raw[k - 1] not in HardBreaks + ('SP', 'ZW'):
+            continue
+        if k == i:
+            split = len(units)
+        units.append(('AL', False, False) if c[0] in ('CM', 'ZWJ') else c)
+    left = [u[0] for u in units[:split]]
+    right = [u[0] for u in units[split:]]
+    lu, ru = units[split - 1], units[split]
+    lp, rp = left[-1], right[0]
+
+    def endsWith(pattern):
+        return re.search('(?:^| )(?:%s)$' % pattern, ' '.join(left))
+
+    def startsWith(pattern):
+        return re.match('(?:%s)(?: |$)' % pattern, ' '.join(right))
+
+    if rp == 'WJ':
+        return ('11.01', False)
+    if lp == 'WJ':
+        return ('11.02', False)
+    if lp == 'GL':
+        return ('12.0', False)
+    if lp not in ('SP', 'BA', 'HY') and rp == 'GL':
+        return ('12.1', False)
+    if rp in ('CL', 'CP', 'EX', 'IS', 'SY'):
+        return ('13.0', False)
+    if endsWith('OP( SP)*'):
+        return ('14.0', False)
+    if endsWith('QU( SP)*') and rp == 'OP':
+        return ('15.0', False)
+    if endsWith('(CL|CP)( SP)*') and rp == 'NS':
+        return ('16.0', False)
+    if endsWith('B2( SP)*') and rp == 'B2':
+        return ('17.0', False)
+    if lp == 'SP':
+        return ('18.0', True)
+    if rp == 'QU':
+        return ('19.01', False)
+    if lp == 'QU':
+        return ('19.02', False)
+    if rp == 'CB':
+        return ('20.01', True)
+    if lp == 'CB':
+        return ('20.02', True)
+    if rp in ('BA', 'HY', 'NS'):
+        return ('21.01', False)
+    if lp == 'BB':
+        return ('21.04', False)
+    if endsWith('HL (HY|BA)'):
+        return ('21.1', False)
+    if lp == 'SY' and rp == 'HL':
+        return ('21.2', False)
+    if rp == 'IN':
+        return ('22.0', False)
+    if lp in ('AL', 'HL') and rp == 'NU':
+        return ('23.02', False)
+    if lp == 'NU' and rp in ('AL', 'HL'):
+        return ('23.03', False)
+    if lp == 'PR' and rp in ('ID', 'EB', 'EM'):
+        return ('23.12', False)
+    if lp in ('ID', 'EB', 'EM') and rp == 'PO':
+        return ('23.13', False)
+    if lp in ('PR', 'PO') and rp in ('AL', 'HL'):
+        return ('24.02', False)
+    if lp in ('AL', 'HL') and rp in ('PR', 'PO'):
+        return ('24.03', False)
+    if lp in ('PR', 'PO') and startsWith('((OP|HY) )?NU'):
+        return ('25.01', False)
+    if lp in ('OP', 'HY') and rp == 'NU':
+        return ('25.02', False)
+    if endsWith('NU( (NU|SY|IS))*') and rp in ('NU', 'SY', 'IS', 'CL', 'CP'):
+        return ('25.03', False)
+    if endsWith('NU( (NU|SY|IS))*( (CL|CP))?') and rp in ('PO', 'PR'):
+        return ('25.05', False)
+    if lp == 'JL' and rp in ('JL', 'JV', 'H2', 'H3'):
+        return ('26.01', False)
+    if lp in ('JV', 'H2') and rp in ('JV', 'JT'):
+        return ('26.02', False)
+    if lp in ('JT', 'H3') and rp == 'JT':
+        return ('26.03', False)
+    Korean = ('JL', 'JV', 'JT', 'H2', 'H3')
+    if lp in Korean and rp == 'PO':
+        return ('27.01', False)
+    if lp == 'PR' and rp in Korean:
+        return ('27.02', False)
+    if lp in ('AL', 'HL') and rp in ('AL', 'HL'):
+        return ('28.0', False)
+    if lp == 'IS' and rp in ('AL', 'HL'):
+        return ('29.0', False)
+    if lp in ('AL', 'HL', 'NU') and rp == 'OP' and not ru[1]:
+        return ('30.01', False)
+    if lp == 'CP' and not lu[1] and rp in ('AL', 'HL', 'NU'):
+        return ('30.02', False)
+    if rp == 'RI' and len(re.search('( RI)*$', ' ' + ' '.join(left))
+                          .group(0).split()) % 2 == 1:
+        return ('30.11', False)
+    if (lp == 'EB' or lu[2]) and rp == 'EM':
+        return ('30.12', False)
+    return ('31.0', True)
+
+#------------------------------------------------------------------------------
+# Test strings
+#------------------------------------------------------------------------------
+
+# Code points of text in several scripts, as the Unicode file ends with.
+Samples = [
+    u'The quick ("brown") fox can’t jump 32.3 feet, right?',
+    u'The quick (“brown”) fox can’t jump 32.3 feet, right?',
+    u'Text—with dashes–here - and  spaces.',
+    u'$(12.35) 2,1234 (12)¢ (12.4)% -1 +1 1/2 a/1 1.5e10',
+    u'12.34 %, 1-2, -12, (1)-(2), $-3, 1:30 a.m.',
+    u'“¿¡Español!?” «très»',
+    u'http://example.com/path?a=1&b=2; user@example.com',
+    u'e.g. etc. i.e., \'quoted\' "double"',
+    u'אב-ג ד׳ה וּז',
+    u'日本語のテキスト。「引用」、ぁぃー々',
+    u'（全角）【括弧】『あ』',
+    u'각가 가각 한국어.',
+    u'क्ष नमस्ते। ภาษาไทย',
+    u'á̂ ́b ​c​ ​ d⁠e ­f',
+    u'\U0001F44D\U0001F3FD\U0001F44D ☝\U0001F3FB \U0001F469‍\U0001F4BB \U0001FA7B\U0001F3FB',
+    u'\U0001F1EF\U0001F1F5\U0001F1FA\U0001F1F8\U0001F1EF \U0001F1EF́\U0001F1F5',
+    u'a\u000Db\u000D\u000Ac\u000Ad\u000Be\u000Cf\u0085g h ',
+    u'x——y — —z ․․ …… 12․',
+    u'(a) [b] {c} "(d)" a (b) 1(2) 〈a〉b',
+    u'‘a’ „b“ »c« ›d‹',
+    u'กำไร က်က ៖x ។',
+]
+
+def getSampleCodePoints(lineBreak, categories):
+    # The first code point of each Line_Break value which isn't a control, or
+    # which is if there is nothing else.
+    samples = {}
+    for cp in range(MaxCode + 1):
+        lb = lineBreak[cp]
+        if lb == 'SG' or (categories[cp] == 'Cn' and lb != 'XX'):
+            continue
+        if lb not in samples or \
+           (categories[samples[lb]] == 'Cc' and categories[cp] != 'Cc'):
+            samples[lb] = cp
+    return [samples[lb] for lb in sorted(samples)]
+
+#------------------------------------------------------------------------------
+# Main
+#------------------------------------------------------------------------------
+
+def writeTest(ucd, lineBreakDir):
+    names, categories = getUnicodeData(ucd)
+    lineBreak = getRangeValues(lineBreakDir + '/LineBreak.txt', 'XX')
+    eastAsianWidth = getRangeValues(lineBreakDir + '/EastAsianWidth.txt', 'N')
+    emoji = getRangeValues(ucd + '/emoji/emoji-data.txt', None)
+    pictographic = set(cp for cp in range(MaxCode + 1)
+                       if emoji[cp] == 'Extended_Pictographic')
+
+    def char(cp):
+        return (resolve(lineBreak[cp], categories[cp]),
+                lineBreak[cp] in ('OP', 'CP') and
+                eastAsianWidth[cp] in ('F', 'W', 'H'),
+                categories[cp] == 'Cn' and cp in pictographic)
+
+    samples = getSampleCodePoints(lineBreak, categories)
+    texts = []
+    for a in samples:
+        for b in samples:
+            texts.append([a, b])
+            texts.append([a, 0x0020, b])
+            texts.append([a, 0x0308, b])
+            texts.append([a, 0x0308, 0x0020, b])
+    for text in Samples:
+        texts.append([ord(c) for c in text])
+
+    fout = open(lineBreakDir + '/LineBreakTest.txt', 'w', encoding='utf-8')
+    fout.write(
+        '# LineBreakTest-13.0.0.txt\n'
+        '#\n'
+        '# Default Line_Break Test\n'
+        '#\n'
+        '# The official file could not be downloaded where this copy was made,\n'
+        '# so it was written by scripts/gen_line_break_test.py instead, from the\n'
+        '# rules of UAX #14 for Unicode 13.0.0, the data of this directory and\n'
+        '# that of UCD/. It is kept out of UCD/ since it is not Unicode data.\n'
+        '# Its strings follow the official file: pairs of the sample characters\n'
+        '# of each class, by themselves and with U+0020 and U+0308 between them,\n'
+        '# followed by some text. LB25 takes the regular expression form of\n'
+        '# example 7 of UAX #14 section 8.2, as in the official file.\n'
+        '#\n'
+        '# Format:\n'
+        '# <string> (# <comment>)?\n'
+        '#  <string> contains hex Unicode code points, with\n'
+        '#\t\xf7 wherever there is a break opportunity, and\n'
+        '#\t\xd7 wherever there is not.\n'
+        '#  <comment> shows the name and Line_Break value of each character,\n'
+        '#\tand the rule which decides each break, numbered as in UAX #14.\n'
+        '#\n')
+    for text in texts:
+        chars = [char(cp) for cp in text]
+        line = [u'\xd7']
+        comment = [u' \xd7 [0.3]']
+        for i, cp in enumerate(text):
+            if i > 0:
+                rule, brk = lineBreakAt(chars, i)
+                mark = u'\xf7' if brk else u'\xd7'
+                line.append(mark)
+                comment.append(u'%s [%s]' % (mark, rule))
+            line.append(u'%04X' % cp)
+            comment.append(u'%s (%s)' % (names.get(cp, '<reserved-%04X>' % cp),
+                                         lineBreak[cp]))
+        line.append(u'\xf7')
+        comment.append(u'\xf7 [0.3]')
+        fout.write(u' '.join(line) + u'\t#' + u' '.join(comment) + u'\n')
+    fout.write('# EOF\n')
+
+if __name__ == '__main__':
+    writeTest(sys.argv[1], sys.argv[2])
@@ -7,6 +7,10 @@ import re
 
 MaxCode = 0x0010FFFF
 
+# Number of low code point bits that index into a trie block. This must match
+# `TrieBlockBits` in 'src/unicodelib_data.h'.
+TrieBlockBits = 7
+
 #------------------------------------------------------------------------------
 # Utilities
 #------------------------------------------------------------------------------
@@ -16,13 +20,36 @@ def to_unicode_literal(str):
         return 'U"%s"' % ''.join([('\\U%08X' % x) for x in str])
     return 'nullptr'
 
+def writeTrie(fout, name, type, values):
+    # Split the per code point values into fixed size blocks, share identical
+    # blocks, and emit a block index (stage 1) plus the unique blocks (stage 2).
+    blockSize = 1 << TrieBlockBits
+    blocks = {}
+    index = []
+    data = []
+    for cp in range(0, MaxCode + 1, blockSize):
+        block = tuple(values[cp:cp + blockSize])
+        if not block in blocks:
+            blocks[block] = len(blocks)
+            data.extend(block)
+        index.append(blocks[block])
+
+    fout.write("static const uint16_t %s_index[] = {\n" % name)
+    for i in index:
+        fout.write("%d,\n" % i)
+    fout.write("};\n")
+    fout.write("static const %s %s_data[] = {\n" % (type, name))
+    for val in data:
+        fout.write("%s,\n" % val)
+    fout.write("};\n")
+    fout.write("const Trie<%s> %s = { %s_index, %s_data };\n" % (type, name, name, name))
+
 #------------------------------------------------------------------------------
-# genGeneralCategoryPropertyTable
+# getGeneralCategoryValues
 #------------------------------------------------------------------------------
 
-def genGeneralCategoryPropertyTable(ucd, out):
+def getGeneralCategoryValues(ucd):
     fin = open(ucd + '/UnicodeData.txt')
-    fout = open(out + '/_general_category_properties.cpp', 'w')
 
     data = [x.rstrip().split(';') for x in fin]
 
@@ -53,18 +80,14 @@ def genGeneralCategoryPropertyTable(ucd, out):
         for cp in range(codePointPrev + 1, MaxCode + 1):
             yield cp, 'Cn'
 
-    fout.write("const GeneralCategory _general_category_properties[] = {\n")
-    for cp, val in items():
-        fout.write("GeneralCategory::%s,\n" % val)
-    fout.write("};\n")
+    return [val for cp, val in items()]
 
 #------------------------------------------------------------------------------
-# getPropertyTable
+# getPropertyValues
 #------------------------------------------------------------------------------
 
-def getPropertyTable(ucd, out):
+def getPropertyValues(ucd):
     fin = open(ucd + '/PropList.txt')
-    fout = open(out + '/_properties.cpp', 'w')
 
     values = [0] * (MaxCode + 1)
     names = {}
@@ -86,18 +109,14 @@ def getPropertyTable(ucd, out):
             else:
                 values[codePoint] += (1 << val)
 
-    fout.write("const uint64_t _properties[] = {\n")
-    for val in values:
-        fout.write("0x%016X,\n" % val)
-    fout.write("};\n")
+    return values
 
 #------------------------------------------------------------------------------
-# getDerivedCorePropertyTable
+# getDerivedCorePropertyValues
 #------------------------------------------------------------------------------
 
-def getDerivedCorePropertyTable(ucd, out):
+def getDerivedCorePropertyValues(ucd):
     fin = open(ucd + '/DerivedCoreProperties.txt')
-    fout = open(out + '/_derived_core_properties.cpp', 'w')
 
     values = [0] * (MaxCode + 1)
     names = {}
@@ -119,10 +138,47 @@ def getDerivedCorePropertyTable(ucd, out):
             else:
                 values[codePoint] += (1 << val)
 
-    fout.write("const uint32_t _derived_core_properties[] = {\n")
-    for val in values:
-        fout.write("0x%08X,\n" % val)
-    fout.write("};\n")
+    return values
+
+#------------------------------------------------------------------------------
+# getSpecialCasingItems
+#------------------------------------------------------------------------------
+
+def getSpecialCasingItems(ucd):
+    fin = open(ucd + '/SpecialCasing.txt')
+
+    r = re.compile(r"(?!#)(.+?); #")
+
+    def to_array(str):
+        if len(str):
+            return str.split(' ')
+        return []
+
+    def is_language(str):
+        return str in ('lt', 'tr', 'az')
+
+    for line in fin:
+        m = r.match(line)
+        if m:
+            flds = m.group(1).split('; ')
+
+            cp = int(flds[0], 16)
+            lower = [int(x, 16) for x in to_array(flds[1])]
+            title = [int(x, 16) for x in to_array(flds[2])]
+            upper = [int(x, 16) for x in to_array(flds[3])]
+
+            hasContext = False
+            language = 'nullptr'
+            context = 'Unassigned'
+            if len(flds) == 5:
+                hasContext = True
+                for x in to_array(flds[4]):
+                    if is_language(x):
+                        language = '"%s"' % x
+                    else:
+                        context = x
+
+            yield cp, lower, title, upper, language, context, hasContext
 
 #------------------------------------------------------------------------------
 # getSimpleCaseMappingTable
@@ -133,10 +189,8 @@ def getSimpleCaseMappingTable(ucd, out):
     fout = open(out + '/_simple_case_mappings.cpp', 'w')
 
     data = [x.rstrip().split(';') for x in fin]
-    r = re.compile(r"(?:<(\w+)> )?(.+)")
 
     def items():
-        codePointPrev = -1
         i = 0
         while i < len(data):
             flds = data[i]
@@ -146,9 +200,6 @@ def getSimpleCaseMappingTable(ucd, out):
             title = flds[14]
 
             if flds[1].endswith('First>'):
-                fldsLast = data[i + 1]
-                codePointLast = int(fldsLast[0], 16)
-                codePointPrev = codePointLast
                 i += 2
             else:
                 if len(upper) or len(lower) or len(title):
@@ -159,12 +210,35 @@ def getSimpleCaseMappingTable(ucd, out):
                     if len(title) == 0:
                         title = flds[0]
                     yield codePoint, int(upper, 16), int(lower, 16), int(title, 16)
-                codePointPrev = codePoint
                 i += 1
 
-    fout.write("const std::unordered_map<char32_t, const char32_t*> _simple_case_mappings = {\n")
+    # Mappings are stored as deltas from the code point, so that the many
+    # letters sharing the same offset (e.g. +32 for ASCII) share one record.
+    # `special` tells whether 'SpecialCasing.txt' has conditional (bit 0) or
+    # unconditional (bit 1) entries for the code point.
+    values = [(0, 0, 0, 0)] * (MaxCode + 1)
     for cp, upper, lower, title in items():
-        fout.write('{ 0x%08X, U"\\U%08X\\U%08X\\U%08X" },\n' % (cp, upper, lower, title))
+        values[cp] = (upper - cp, lower - cp, title - cp, 0)
+
+    for cp, lower, title, upper, language, context, hasContext in getSpecialCasingItems(ucd):
+        value = values[cp]
+        special = value[3] | (1 if hasContext else 2)
+        values[cp] = (value[0], value[1], value[2], special)
+
+    records = [(0, 0, 0, 0)]
+    recordIds = { records[0]: 0 }
+    ids = []
+    for value in values:
+        if not value in recordIds:
+            recordIds[value] = len(records)
+            records.append(value)
+        ids.append("%d" % recordIds[value])
+
+    writeTrie(fout, '_simple_case_mapping_ids', 'uint16_t', ids)
+
+    fout.write("const CaseMapping _simple_case_mappings[] = {\n")
+    for record in records:
+        fout.write("{ %d, %d, %d, %d },\n" % record)
     fout.write("};\n")
 
 #------------------------------------------------------------------------------
@@ -172,57 +246,29 @@ def getSimpleCaseMappingTable(ucd, out):
 #------------------------------------------------------------------------------
 
 def getSpecialCaseMappingTable(ucd, out):
-    fin = open(ucd + '/SpecialCasing.txt')
     fout = open(out + '/_special_case_mappings.cpp', 'w')
     foutDefault = open(out + '/_special_case_mappings_default.cpp', 'w')
 
-    r = re.compile(r"(?!#)(.+?); #")
+    # Both tables are sorted by code point (keeping the file order among
+    # entries of the same code point) so that they can be binary searched.
+    entries = sorted(getSpecialCasingItems(ucd), key=lambda x: x[0])
 
-    def to_array(str):
-        if len(str):
-            return str.split(' ')
-        return []
-
-    def is_language(str):
-        return str in ('lt', 'tr', 'az')
-
-    def items():
-        for line in fin:
-            m = r.match(line)
-            if m:
-                flds = m.group(1).split('; ')
-
-                cp = int(flds[0], 16)
-                lower = [int(x, 16) for x in to_array(flds[1])]
-                title = [int(x, 16) for x in to_array(flds[2])]
-                upper = [int(x, 16) for x in to_array(flds[3])]
-
-                hasContext = False
-                language = 'nullptr'
-                context = 'Unassigned'
-                if len(flds) == 5:
-                    hasContext = True
-                    for x in to_array(flds[4]):
-                        if is_language(x):
-                            language = '"%s"' % x
-                        else:
-                            context = x
-
-                yield cp, lower, title, upper, language, context, hasContext
-
-    fout.write("const std::unordered_multimap<char32_t, SpecialCasing> _special_case_mappings = {\n")
-    foutDefault.write("const std::unordered_multimap<char32_t, SpecialCasing> _special_case_mappings_default = {\n")
-    for cp, lower, title, upper, language, context, hasContext in items():
+    fout.write("const SpecialCasing _special_case_mappings[] = {\n")
+    foutDefault.write("const SpecialCasing _special_case_mappings_default[] = {\n")
+    for cp, lower, title, upper, language, context, hasContext in entries:
         if hasContext:
             f = fout
         else:
             f = foutDefault
-        f.write('{ 0x%08X, { %s, %s, %s, %s, SpecialCasingContext::%s } },\n'
+        f.write('{ 0x%08X, %s, %s, %s, %s, SpecialCasingContext::%s },\n'
                 % (cp, to_unicode_literal(lower), to_unicode_literal(title),
                     to_unicode_literal(upper), language, context))
     fout.write("};\n")
     foutDefault.write("};\n")
 
+    for f, name in ((fout, '_special_case_mappings'), (foutDefault, '_special_case_mappings_default')):
+        f.write("const size_t %s_count = sizeof(%s) / sizeof(%s[0]);\n" % (name, name, name))
+
 #------------------------------------------------------------------------------
 # getCaseFoldingTable
 #------------------------------------------------------------------------------
@@ -233,7 +279,9 @@ def getCaseFoldingTable(ucd, out):
 
     r = re.compile(r"(.+?); ([CFST]); (.+?); #.*")
 
-    dic = {}
+    # 'S' entries only exist alongside 'F' ones, so the 'C' and 'S' mappings
+    # share the `simple` field, stored as a delta from the code point.
+    values = [(0, (), 0)] * (MaxCode + 1)
 
     for line in fin:
         m = r.match(line)
@@ -241,22 +289,29 @@ def getCaseFoldingTable(ucd, out):
             cp = int(m.group(1), 16)
             status = m.group(2)
             codes = [int(x, 16) for x in m.group(3).split(' ')]
-            if not cp in dic:
-                dic[cp] = [0, 0, [], 0]
-            if status == 'C':
-                dic[cp][0] = codes[0]
-            elif status == 'S':
-                dic[cp][1] = codes[0]
+            simple, full, turkic = values[cp]
+            if status == 'C' or status == 'S':
+                simple = codes[0] - cp
             elif status == 'F':
-                dic[cp][2] = codes
+                full = tuple(codes)
             elif status == 'T':
-                dic[cp][3] = codes[0]
-
-    fout.write("const std::unordered_map<char32_t, CaseFolding> _case_foldings = {\n")
-    for cp in dic:
-        cf = dic[cp]
-        f = to_unicode_literal(cf[2])
-        fout.write('{ 0x%08X, { 0x%08X,  0x%08X, %s, 0x%08X } },\n' % (cp, cf[0], cf[1], f, cf[3]))
+                turkic = codes[0]
+            values[cp] = (simple, full, turkic)
+
+    records = [(0, (), 0)]
+    recordIds = { records[0]: 0 }
+    ids = []
+    for value in values:
+        if not value in recordIds:
+            recordIds[value] = len(records)
+            records.append(value)
+        ids.append("%d" % recordIds[value])
+
+    writeTrie(fout, '_case_folding_ids', 'uint16_t', ids)
+
+    fout.write("const CaseFolding _case_foldings[] = {\n")
+    for simple, full, turkic in records:
+        fout.write('{ %d, %s, 0x%08X },\n' % (simple, to_unicode_literal(full), turkic))
     fout.write("};\n")
 
 #------------------------------------------------------------------------------
@@ -280,18 +335,15 @@ def genBlockPropertyTable(ucd, out):
             for cp in range(codePointFirst, codePointLast + 1):
                 values[cp] = block
 
-    fout.write("const Block _block_properties[] = {\n")
-    for val in values:
-        fout.write("    Block::%s,\n" % val)
-    fout.write("};\n")
+    writeTrie(fout, '_block_properties', 'Block',
+              ["Block::%s" % val for val in values])
 
 #------------------------------------------------------------------------------
-# genScriptPropertyTable
+# getScriptValues
 #------------------------------------------------------------------------------
 
-def genScriptPropertyTable(ucd, out):
+def getScriptValues(ucd):
     fin = open(ucd + '/Scripts.txt')
-    fout = open(out + '/_script_properties.cpp', 'w')
 
     values = ['Unassigned'] * (MaxCode + 1)
     r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s+;\s+(\w+)\s+#.*")
@@ -309,10 +361,7 @@ def genScriptPropertyTable(ucd, out):
             else:
                 values[codePoint] = value
 
-    fout.write("const Script _script_properties[] = {\n")
-    for val in values:
-        fout.write("Script::%s,\n" % val)
-    fout.write("};\n")
+    return values
 
 #------------------------------------------------------------------------------
 # genScriptExtensionIdTable
@@ -343,10 +392,8 @@ def genScriptExtensionIdTable(ucd, out):
                 else:
                     values[codePoint] = id
 
-    fout.write("const int _script_extension_ids[] = {\n")
-    for id in values:
-        fout.write("%d,\n" % id)
-    fout.write("};\n")
+    writeTrie(fout, '_script_extension_ids', 'int',
+              ["%d" % id for id in values])
 
 #------------------------------------------------------------------------------
 # genScriptExtensionPropertyForIdTable
@@ -534,12 +581,11 @@ def genScriptExtensionPropertyForIdTable(ucd, out):
     fout.write("};\n")
 
 #------------------------------------------------------------------------------
-# genNomalizationPropertyTable
+# getNormalizationItems
 #------------------------------------------------------------------------------
 
-def genNomalizationPropertyTable(ucd, out):
+def getNormalizationItems(ucd):
     fin = open(ucd + '/UnicodeData.txt')
-    fout = open(out + '/_normalization_properties.cpp', 'w')
 
     data = [x.rstrip().split(';') for x in fin]
     r = re.compile(r"(?:<(\w+)> )?(.+)")
@@ -577,17 +623,135 @@ def genNomalizationPropertyTable(ucd, out):
         for cp in range(codePointPrev + 1, MaxCode + 1):
             yield cp, combiningClass, None, []
 
-    fout.write("const NormalizationProperties _normalization_properties[] = {\n")
-    for cp, cls, compat, codes in items():
+    return items()
+
+def getCombiningClassValues(ucd):
+    return [cls for cp, cls, compat, codes in getNormalizationItems(ucd)]
+
+#------------------------------------------------------------------------------
+# getCompositionExclusions
+#------------------------------------------------------------------------------
+
+def getCompositionExclusions(ucd):
+    fin = open(ucd + '/CompositionExclusions.txt')
+
+    exclusions = set()
+    rRange = re.compile(r"(?:# )?([0-9A-F]{4,})(?:\.\.([0-9A-F]+))?.*")
+    for line in fin:
+        m = rRange.match(line)
+        if m:
+            first = int(m.group(1), 16)
+            if m.group(2):
+                last = int(m.group(2), 16)
+                for i in range(first, last + 1):
+                    exclusions.add(i)
+            else:
+                exclusions.add(first)
+    return exclusions
+
+#------------------------------------------------------------------------------
+# getQuickCheckValues
+#------------------------------------------------------------------------------
+
+def getQuickCheckValues(ucd):
+    # 'DerivedNormalizationProps.txt' isn't part of the bundled data, so the
+    # NFC/NFD/NFKC/NFKD quick check properties are derived the same way that
+    # file is, from the decompositions in 'UnicodeData.txt' and
+    # 'CompositionExclusions.txt'. Values are packed 2 bits per form in the
+    # order of `Normalization`, with 0 = Yes, 1 = No and 2 = Maybe.
+    SBase, SCount = 0xAC00, 11172
+    VFirst, VLast = 0x1161, 0x1175
+    TFirst, TLast = 0x11A8, 0x11C2
+
+    classes = {}
+    decompositions = {}
+    for cp, cls, compat, codes in getNormalizationItems(ucd):
+        classes[cp] = cls
+        if codes:
+            decompositions[cp] = (compat, codes)
+
+    def decompose(cp, compat):
+        if cp in decompositions:
+            format, codes = decompositions[cp]
+            if compat or not format:
+                return [y for x in codes for y in decompose(x, compat)]
+        return [cp]
+
+    exclusions = getCompositionExclusions(ucd)
+
+    # Full_Composition_Exclusion: explicit exclusions, singletons and
+    # non-starter decompositions never appear in NFC.
+    fullExclusions = set()
+    seconds = set(range(VFirst, VLast + 1)) | set(range(TFirst, TLast + 1))
+    for cp, (compat, codes) in decompositions.items():
         if compat:
-            compat = '"%s"' % compat
+            continue
+        if (cp in exclusions or len(codes) == 1 or classes[cp] != 0 or
+                classes[decompose(cp, False)[0]] != 0):
+            fullExclusions.add(cp)
         else:
-            compat = 'nullptr'
-        if codes:
-            codes = 'U"%s"' % ''.join(["\\U%08X" % x for x in codes])
+            seconds.add(codes[1])
+
+    Yes, No, Maybe = 0, 1, 2
+    values = []
+    for cp in range(0, MaxCode + 1):
+        hangul = SBase <= cp < SBase + SCount
+        nfd = No if hangul or decompose(cp, False) != [cp] else Yes
+        nfkd = No if hangul or decompose(cp, True) != [cp] else Yes
+        if cp in fullExclusions:
+            nfc = No
+        elif cp in seconds:
+            nfc = Maybe
+        else:
+            nfc = Yes
+        if nfc == No or decompose(cp, True) != decompose(cp, False):
+            nfkc = No
         else:
-            codes = 'nullptr'
-        fout.write("{ %d, %s, %s },\n" % (cls, compat, codes))
+            nfkc = nfc
+        values.append(nfc | (nfd << 2) | (nfkc << 4) | (nfkd << 6))
+    return values
+
+#------------------------------------------------------------------------------
+# genNomalizationPropertyTable
+#------------------------------------------------------------------------------
+
+def genNomalizationPropertyTable(ucd, out):
+    fout = open(out + '/_normalization_properties.cpp', 'w')
+
+    # Decompositions are stored once each in a contiguous code pool. Code
+    # points refer to them through a small index, where 0 means 'none'.
+    ids = []
+    decompositions = [(0, 0, 'None')]
+    pool = []
+    poolOffsets = {}
+    decompositionIds = {}
+    for cp, cls, compat, codes in getNormalizationItems(ucd):
+        id = 0
+        if codes:
+            if compat:
+                format = compat[0].upper() + compat[1:]
+            else:
+                format = 'None'
+            key = (tuple(codes), format)
+            if not key in decompositionIds:
+                if not tuple(codes) in poolOffsets:
+                    poolOffsets[tuple(codes)] = len(pool)
+                    pool.extend(codes)
+                decompositionIds[key] = len(decompositions)
+                decompositions.append((poolOffsets[tuple(codes)], len(codes), format))
+            id = decompositionIds[key]
+        ids.append("%d" % id)
+
+    writeTrie(fout, '_decomposition_properties', 'uint16_t', ids)
+
+    fout.write("const Decomposition _decompositions[] = {\n")
+    for offset, length, format in decompositions:
+        fout.write("{ %d, %d, CompatFormat::%s },\n" % (offset, length, format))
+    fout.write("};\n")
+
+    fout.write("const char32_t _decomposition_codes[] = {\n")
+    for cp in pool:
+        fout.write("0x%08X,\n" % cp)
     fout.write("};\n")
 
 #------------------------------------------------------------------------------
@@ -596,7 +760,6 @@ def genNomalizationPropertyTable(ucd, out):
 
 def genNomalizationCompositionTable(ucd, out):
     fin = open(ucd + '/UnicodeData.txt')
-    finExclusions = open(ucd + '/CompositionExclusions.txt')
     fout = open(out + '/_normalization_composition.cpp', 'w')
 
     data = [x.rstrip().split(';') for x in fin]
@@ -626,32 +789,28 @@ def genNomalizationCompositionTable(ucd, out):
                 codePointPrev = codePoint
                 i += 1
 
-    exclusions = set()
-    rRange = re.compile(r"(?:# )?([0-9A-F]{4,})(?:\.\.([0-9A-F]+))?.*")
-    for line in finExclusions:
-        m = rRange.match(line)
-        if m:
-            first = int(m.group(1), 16)
-            if m.group(2):
-                last = int(m.group(2), 16)
-                for i in range(first, last + 1):
-                    exclusions.add(i)
-            else:
-                exclusions.add(first)
+    exclusions = getCompositionExclusions(ucd)
 
-    fout.write("const std::unordered_map<std::u32string, char32_t> _normalization_composition = {\n")
+    # Pairs are packed into a 64-bit key and sorted, so that the table can be
+    # binary searched without building a string key.
+    compositions = []
     for cp, codes in items():
         if not cp in exclusions:
-            fout.write('{ U"\\U%08X\\U%08X", 0x%08X },\n' % (codes[0], codes[1], cp))
+            compositions.append(((codes[0] << 32) | codes[1], cp))
+    compositions.sort()
+
+    fout.write("const Composition _normalization_composition[] = {\n")
+    for key, cp in compositions:
+        fout.write('{ 0x%016X, 0x%08X },\n' % (key, cp))
     fout.write("};\n")
+    fout.write("const size_t _normalization_composition_count = sizeof(_normalization_composition) / sizeof(_normalization_composition[0]);\n")
 
 #------------------------------------------------------------------------------
-# getGraphemeBreakPropertyTable
+# getGraphemeBreakValues
 #------------------------------------------------------------------------------
 
-def getGraphemeBreakPropertyTable(ucd, out):
+def getGraphemeBreakValues(ucd):
     fin = open(ucd + '/auxiliary/GraphemeBreakProperty.txt')
-    fout = open(out + '/_grapheme_break_properties.cpp', 'w')
 
     values = ['Unassigned'] * (MaxCode + 1)
     r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)\s*#.*")
@@ -669,18 +828,14 @@ def getGraphemeBreakPropertyTable(ucd, out):
             else:
                 values[codePoint] = value
 
-    fout.write("const GraphemeBreak _grapheme_break_properties[] = {\n")
-    for val in values:
-        fout.write("GraphemeBreak::%s,\n" % val)
-    fout.write("};\n")
+    return values
 
 #------------------------------------------------------------------------------
-# getWordBreakPropertyTable
+# getWordBreakValues
 #------------------------------------------------------------------------------
 
-def getWordBreakPropertyTable(ucd, out):
+def getWordBreakValues(ucd):
     fin = open(ucd + '/auxiliary/WordBreakProperty.txt')
-    fout = open(out + '/_word_break_properties.cpp', 'w')
 
     values = ['Unassigned'] * (MaxCode + 1)
     r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)\s*#.*")
@@ -698,18 +853,14 @@ def getWordBreakPropertyTable(ucd, out):
             else:
                 values[codePoint] = value
 
-    fout.write("const WordBreak _word_break_properties[] = {\n")
-    for val in values:
-        fout.write("WordBreak::%s,\n" % val)
-    fout.write("};\n")
+    return values
 
 #------------------------------------------------------------------------------
-# getSentenceBreakPropertyTable
+# getSentenceBreakValues
 #------------------------------------------------------------------------------
 
-def getSentenceBreakPropertyTable(ucd, out):
+def getSentenceBreakValues(ucd):
     fin = open(ucd + '/auxiliary/SentenceBreakProperty.txt')
-    fout = open(out + '/_sentence_break_properties.cpp', 'w')
 
     values = ['Unassigned'] * (MaxCode + 1)
     r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)\s*#.*")
@@ -727,18 +878,14 @@ def getSentenceBreakPropertyTable(ucd, out):
             else:
                 values[codePoint] = value
 
-    fout.write("const SentenceBreak _sentence_break_properties[] = {\n")
-    for val in values:
-        fout.write("SentenceBreak::%s,\n" % val)
-    fout.write("};\n")
+    return values
 
 #------------------------------------------------------------------------------
-# getEmojiPropertyTable
+# getEmojiValues
 #------------------------------------------------------------------------------
 
-def getEmojiPropertyTable(ucd, out):
+def getEmojiValues(ucd):
     fin = open(ucd + '/emoji/emoji-data.txt')
-    fout = open(out + '/_emoji_properties.cpp', 'w')
 
     values = ['Unassigned'] * (MaxCode + 1)
     r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)\s*#.*")
@@ -756,34 +903,719 @@ def getEmojiPropertyTable(ucd, out):
             else:
                 values[codePoint] = value
 
-    fout.write("const Emoji _emoji_properties[] = {\n")
-    for val in values:
-        fout.write("Emoji::%s,\n" % val)
+    return values
+
+#------------------------------------------------------------------------------
+# getLineBreakValues
+#------------------------------------------------------------------------------
+
+def getLineBreakValues(ucd):
+    fin = open((LineBreakDir or ucd) + '/LineBreak.txt')
+
+    values = ['XX'] * (MaxCode + 1)
+    r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)")
+
+    for line in fin:
+        m = r.match(line)
+        if m:
+            codePoint = int(m.group(1), 16)
+            value = m.group(3)
+
+            if m.group(2):
+                codePointLast = int(m.group(2), 16)
+                for cp in range(codePoint, codePointLast + 1):
+                    values[cp] = value
+            else:
+                values[codePoint] = value
+
+    return values
+
+#------------------------------------------------------------------------------
+# getEastAsianWidthValues
+#------------------------------------------------------------------------------
+
+def getEastAsianWidthValues(ucd):
+    fin = open((LineBreakDir or ucd) + '/EastAsianWidth.txt')
+
+    values = ['N'] * (MaxCode + 1)
+    r = re.compile(r"([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(\w+)")
+
+    for line in fin:
+        m = r.match(line)
+        if m:
+            codePoint = int(m.group(1), 16)
+            value = m.group(3)
+
+            if m.group(2):
+                codePointLast = int(m.group(2), 16)
+                for cp in range(codePoint, codePointLast + 1):
+                    values[cp] = value
+            else:
+                values[codePoint] = value
+
+    return values
+
+#------------------------------------------------------------------------------
+# Segmentation classes
+#------------------------------------------------------------------------------
+
+# The segmentation rules only tell code points apart by a few properties, so
+# each combination of those which occurs is a class of the state machines
+# below.
+def getClasses(*valueLists):
+    keys = list(zip(*valueLists))
+    classes = sorted(set(keys))
+    classIds = dict((c, i) for i, c in enumerate(classes))
+    return classes, [classIds[key] for key in keys]
+
+def getGraphemeClasses(ucd):
+    return getClasses(getGraphemeBreakValues(ucd),
+                      [value == 'Extended_Pictographic'
+                       for value in getEmojiValues(ucd)])
+
+def getWordClasses(ucd):
+    return getClasses(getWordBreakValues(ucd),
+                      [value == 'Extended_Pictographic'
+                       for value in getEmojiValues(ucd)])
+
+def getSentenceClasses(ucd):
+    return getClasses(getSentenceBreakValues(ucd))
+
+def getLineClasses(ucd):
+    # LB1, with the default resolutions of AI, SA, SG, XX and CJ. LB30 tells
+    # apart OP and CP which are East Asian, and LB30b unassigned
+    # Extended_Pictographic code points.
+    def resolve(lb, gc, ea, emoji):
+        if lb in ('AI', 'SG', 'XX'):
+            lb = 'AL'
+        elif lb == 'SA':
+            lb = 'CM' if gc in ('Mn', 'Mc') else 'AL'
+        elif lb == 'CJ':
+            lb = 'NS'
+        eastAsian = lb in ('OP', 'CP') and ea in ('F', 'W', 'H')
+        pictographic = gc == 'Cn' and emoji == 'Extended_Pictographic'
+        return (lb, eastAsian, pictographic)
+
+    keys = map(resolve, getLineBreakValues(ucd), getGeneralCategoryValues(ucd),
+               getEastAsianWidthValues(ucd), getEmojiValues(ucd))
+    return getClasses(*zip(*keys))
+
+def getGraphemeClassValues(ucd):
+    return getGraphemeClasses(ucd)[1]
+
+def getWordClassValues(ucd):
+    return getWordClasses(ucd)[1]
+
+def getSentenceClassValues(ucd):
+    return getSentenceClasses(ucd)[1]
+
+def getLineClassValues(ucd):
+    return getLineClasses(ucd)[1]
+
+#------------------------------------------------------------------------------
+# buildBreakStateMachine
+#------------------------------------------------------------------------------
+
+# A state stands for what the rules need to know about the text before a
+# position. `advance` gives the state after a code point of a class, and
+# `decide` whether there is a boundary before it: True, False, or, when that
+# depends on the text after it, a look-ahead row with an entry for each class
+# and one for the end of text, which is LookAheadSkip to look further,
+# LookAheadKeep for no boundary and LookAheadBreak for a boundary.
+LookAheadSkip = 0
+LookAheadKeep = 1
+LookAheadBreak = 2
+
+def buildBreakStateMachine(classes, start, advance, decide):
+    states = [start]
+    stateIds = {start: 0}
+    for state in states:
+        for c in classes:
+            next = advance(state, c)
+            if not next in stateIds:
+                stateIds[next] = len(states)
+                states.append(next)
+
+    # Merge states which can't be told apart, refining them by what they do
+    # for each class until nothing changes.
+    decisions = [[decide(state, c) for c in classes] for state in states]
+    nexts = [[stateIds[advance(state, c)] for c in classes] for state in states]
+    blocks = [0] * len(states)
+    while True:
+        keys = [(blocks[i], tuple(zip(decisions[i],
+                                      [blocks[j] for j in nexts[i]])))
+                for i in range(len(states))]
+        # Keep the start of text first.
+        order = {}
+        for key in keys:
+            if not key in order:
+                order[key] = len(order)
+        refined = [order[key] for key in keys]
+        if len(order) == len(set(blocks)):
+            break
+        blocks = refined
+
+    rows = [None] * len(set(blocks))
+    for i in range(len(states)):
+        rows[blocks[i]] = list(zip(decisions[i], [blocks[j] for j in nexts[i]]))
+    return rows
+
+# `flags` names the boolean properties which follow the first one.
+def writeClasses(fout, classes, flags=('Extended_Pictographic',)):
+    fout.write("// Classes:\n")
+    for i, c in enumerate(classes):
+        names = [c[0]] + [flag for flag, v in zip(flags, c[1:]) if v]
+        fout.write("//   %d: %s\n" % (i, ', '.join(names)))
+
+# Writes entries with the offset of the next state's row in the low 9 bits, the
+# high bit set if there is a boundary before the code point, and otherwise, if
+# that depends on the text after it, the number of the look-ahead row in bits 9
+# to 14.
+def writeBreakStateMachine(fout, name, classes, rows):
+    lookAheadRows = []
+    for row in rows:
+        for decision, next in row:
+            if type(decision) == tuple and not decision in lookAheadRows:
+                lookAheadRows.append(decision)
+    assert len(rows) * len(classes) <= 512 and len(lookAheadRows) < 64
+
+    writeClasses(fout, classes)
+    fout.write("const size_t %s_class_count = %d;\n" % (name, len(classes)))
+    fout.write("const uint16_t %s[] = {\n" % name)
+    for row in rows:
+        values = []
+        for decision, next in row:
+            if type(decision) == tuple:
+                values.append(((lookAheadRows.index(decision) + 1) << 9) |
+                              next * len(classes))
+            else:
+                values.append((0x8000 if decision else 0) | next * len(classes))
+        fout.write(''.join(["0x%04X," % v for v in values]) + "\n")
+    fout.write("};\n")
+    fout.write("const uint8_t %s_lookahead[] = {\n" % name)
+    for row in lookAheadRows:
+        fout.write(''.join(["%d," % v for v in row]) + "\n")
+    fout.write("};\n")
+
+#------------------------------------------------------------------------------
+# genGraphemeBreakTable
+#------------------------------------------------------------------------------
+
+# GB3 to GB999, as in `grapheme_break_between` in unicodelib.cpp.
+def graphemeBreakBetween(lp, rp, rpPictographic, afterEmojiZWJ, afterOddRI):
+    if lp == 'CR' and rp == 'LF':
+        return False
+    if lp in ('Control', 'CR', 'LF'):
+        return True
+    if rp in ('Control', 'CR', 'LF'):
+        return True
+    if lp == 'L' and rp in ('L', 'V', 'LV', 'LVT'):
+        return False
+    if lp in ('LV', 'V') and rp in ('V', 'T'):
+        return False
+    if lp in ('LVT', 'T') and rp == 'T':
+        return False
+    if rp in ('Extend', 'ZWJ'):
+        return False
+    if rp == 'SpacingMark':
+        return False
+    if lp == 'Prepend':
+        return False
+    if afterEmojiZWJ and rpPictographic:
+        return False
+    if afterOddRI and rp == 'Regional_Indicator':
+        return False
+    return True
+
+def genGraphemeBreakTable(ucd, out):
+    fout = open(out + '/_grapheme_break_dfa.cpp', 'w')
+
+    classes = getGraphemeClasses(ucd)[0]
+
+    # The previous code point, whether the text ends with
+    # '\p{Extended_Pictographic} Extend*' or that followed by ZWJ, and whether
+    # it ends with an odd number of regional indicators.
+    def advance(state, c):
+        lp, emoji, oddRI = state
+        rp, pictographic = c
+        if pictographic:
+            emoji = 'Pictographic'
+        elif emoji != 'Pictographic':
+            emoji = 'None'
+        elif rp == 'ZWJ':
+            emoji = 'ZWJ'
+        elif rp != 'Extend':
+            emoji = 'None'
+        oddRI = rp == 'Regional_Indicator' and not oddRI
+        return (rp, emoji, oddRI)
+
+    def decide(state, c):
+        lp, emoji, oddRI = state
+        if lp is None:
+            return True
+        return graphemeBreakBetween(lp, c[0], c[1], emoji == 'ZWJ', oddRI)
+
+    rows = buildBreakStateMachine(classes, (None, 'None', False), advance,
+                                  decide)
+    assert len(rows) < 128
+
+    writeClasses(fout, classes)
+    fout.write("const size_t _grapheme_break_dfa_class_count = %d;\n" % len(classes))
+    fout.write("const uint8_t _grapheme_break_dfa[] = {\n")
+    for row in rows:
+        fout.write(''.join(["0x%02X," % ((0x80 if decision else 0) | next)
+                            for decision, next in row]) + "\n")
+    fout.write("};\n")
+
+#------------------------------------------------------------------------------
+# genWordBreakTable
+#------------------------------------------------------------------------------
+
+def isWordBreakIgnored(p):
+    return p in ('Extend', 'Format', 'ZWJ')
+
+# WB3 to WB999, as in `word_break_between` in unicodelib.cpp.
+def wordBreakBetween(state, rp, rpPictographic, rp1):
+    lp, left, left2, oddRI = state
+    AHLetter = ('ALetter', 'Hebrew_Letter')
+    MidNumLetQ = ('MidNumLet', 'Single_Quote')
+
+    if lp == 'CR' and rp == 'LF':
+        return False
+    if lp in ('Newline', 'CR', 'LF'):
+        return True
+    if rp in ('Newline', 'CR', 'LF'):
+        return True
+    if lp == 'ZWJ' and rpPictographic:
+        return False
+    if lp == 'WSegSpace' and rp == 'WSegSpace':
+        return False
+    if isWordBreakIgnored(rp):
+        return False
+
+    lp = left
+    lp1 = left2
+    if lp in AHLetter and rp in AHLetter:
+        return False
+    if lp in AHLetter and (rp == 'MidLetter' or rp in MidNumLetQ) and \
+       rp1 in AHLetter:
+        return False
+    if lp1 in AHLetter and (lp == 'MidLetter' or lp in MidNumLetQ) and \
+       rp in AHLetter:
+        return False
+    if lp == 'Hebrew_Letter' and rp == 'Single_Quote':
+        return False
+    if lp == 'Hebrew_Letter' and rp == 'Double_Quote' and \
+       rp1 == 'Hebrew_Letter':
+        return False
+    if lp1 == 'Hebrew_Letter' and lp == 'Double_Quote' and \
+       rp == 'Hebrew_Letter':
+        return False
+    if lp == 'Numeric' and rp == 'Numeric':
+        return False
+    if lp in AHLetter and rp == 'Numeric':
+        return False
+    if lp == 'Numeric' and rp in AHLetter:
+        return False
+    if lp1 == 'Numeric' and (lp == 'MidNum' or lp in MidNumLetQ) and \
+       rp == 'Numeric':
+        return False
+    if lp == 'Numeric' and (rp == 'MidNum' or rp in MidNumLetQ) and \
+       rp1 == 'Numeric':
+        return False
+    if lp == 'Katakana' and rp == 'Katakana':
+        return False
+    if (lp in AHLetter or lp in ('Numeric', 'Katakana', 'ExtendNumLet')) and \
+       rp == 'ExtendNumLet':
+        return False
+    if lp == 'ExtendNumLet' and \
+       (rp in AHLetter or rp in ('Numeric', 'Katakana')):
+        return False
+    if lp == 'Regional_Indicator' and rp == 'Regional_Indicator' and oddRI:
+        return False
+    return True
+
+def genWordBreakTable(ucd, out):
+    fout = open(out + '/_word_break_dfa.cpp', 'w')
+
+    classes = getWordClasses(ucd)
+    classes = classes[0]
+    properties = sorted(set([p for p, pictographic in classes]))
+
+    # The previous code point, the first and second ones before it ignoring
+    # Extend, Format and ZWJ as WB4 does, and whether the text ends with an
+    # odd number of regional indicators.
+    def advance(state, c):
+        lp, left, left2, oddRI = state
+        rp = c[0]
+        if isWordBreakIgnored(rp):
+            return (rp, left, left2, oddRI)
+        return (rp, rp, left, rp == 'Regional_Indicator' and not oddRI)
+
+    # WB6, WB7b and WB12 need the next code point which isn't ignored.
+    def decide(state, c):
+        if state[0] is None:
+            return True
+        rp, pictographic = c
+        results = set([wordBreakBetween(state, rp, pictographic, rp1)
+                       for rp1 in properties])
+        if len(results) == 1:
+            return results.pop()
+        def lookAhead(rp1):
+            if isWordBreakIgnored(rp1):
+                return LookAheadSkip
+            if wordBreakBetween(state, rp, pictographic, rp1):
+                return LookAheadBreak
+            return LookAheadKeep
+        return tuple([lookAhead(p) for p, _ in classes] +
+                     [lookAhead('Unassigned')])
+
+    start = (None, 'Unassigned', 'Unassigned', False)
+    rows = buildBreakStateMachine(classes, start, advance, decide)
+    writeBreakStateMachine(fout, '_word_break_dfa', classes, rows)
+
+#------------------------------------------------------------------------------
+# genSentenceBreakTable
+#------------------------------------------------------------------------------
+
+def isSentenceBreakIgnored(p):
+    return p in ('Extend', 'Format')
+
+def isParaSep(p):
+    return p in ('Sep', 'CR', 'LF')
+
+def isSATerm(p):
+    return p in ('STerm', 'ATerm')
+
+def endsSentenceLookAhead(p):
+    return isParaSep(p) or isSATerm(p) or p in ('OLetter', 'Upper', 'Lower')
+
+# SB3 to SB998, as in `sentence_break_between` in unicodelib.cpp.
+def sentenceBreakBetween(state, rp, lowerAhead):
+    lp, left, left2, beforeCloseSp, beforeClose = state
+
+    if lp == 'CR' and rp == 'LF':
+        return False
+    if isParaSep(lp):
+        return True
+    if isSentenceBreakIgnored(rp):
+        return False
+
+    lp = left
+    if lp == 'ATerm' and rp == 'Numeric':
+        return False
+    if left2 in ('Upper', 'Lower') and lp == 'ATerm' and rp == 'Upper':
+        return False
+    if beforeCloseSp == 'ATerm' and lowerAhead:
+        return False
+    if isSATerm(beforeCloseSp) and (rp == 'SContinue' or isSATerm(rp)):
+        return False
+    if isSATerm(beforeClose) and (rp in ('Close', 'Sp') or isParaSep(rp)):
+        return False
+    if isSATerm(beforeCloseSp) and (rp == 'Sp' or isParaSep(rp)):
+        return False
+    if isSATerm(beforeCloseSp):
+        return True
+    return False
+
+def genSentenceBreakTable(ucd, out):
+    fout = open(out + '/_sentence_break_dfa.cpp', 'w')
+
+    classes = getSentenceClasses(ucd)[0]
+
+    # The previous code point, the first and second ones before it ignoring
+    # Extend and Format as SB5 does, and the ones before the 'Close* Sp*' and
+    # 'Close*' which end the text.
+    def advance(state, c):
+        lp, left, left2, beforeCloseSp, beforeClose = state
+        rp = c[0]
+        if isSentenceBreakIgnored(rp):
+            return (rp, left, left2, beforeCloseSp, beforeClose)
+        if rp == 'Close':
+            if left == 'Sp':
+                beforeCloseSp = 'Sp'
+        elif rp != 'Sp':
+            beforeCloseSp = rp
+        if rp != 'Close':
+            beforeClose = rp
+        return (rp, rp, left, beforeCloseSp, beforeClose)
+
+    # SB8 needs to know whether a lowercase letter comes first of the code
+    # points which end its look-ahead, starting from the code point itself.
+    def decide(state, c):
+        if state[0] is None:
+            return True
+        rp = c[0]
+        results = set([sentenceBreakBetween(state, rp, lowerAhead)
+                       for lowerAhead in (False, True)])
+        if len(results) == 1:
+            return results.pop()
+        if endsSentenceLookAhead(rp):
+            return sentenceBreakBetween(state, rp, rp == 'Lower')
+        def lookAhead(rp1):
+            if rp1 is not None and not endsSentenceLookAhead(rp1):
+                return LookAheadSkip
+            if sentenceBreakBetween(state, rp, rp1 == 'Lower'):
+                return LookAheadBreak
+            return LookAheadKeep
+        return tuple([lookAhead(p) for p, in classes] + [lookAhead(None)])
+
+    start = (None,) + ('Unassigned',) * 4
+    rows = buildBreakStateMachine(classes, start, advance, decide)
+    writeBreakStateMachine(fout, '_sentence_break_dfa', classes, rows)
+
+#------------------------------------------------------------------------------
+# genLineBreakTable
+#------------------------------------------------------------------------------
+
+# LB4 to LB31, as described in UAX #14 for Unicode 13.0.0, with LB25 in the
+# regular expression form of example 7 of section 8.2, which LineBreakTest.txt
+# follows. `nuAhead` tells whether NU comes next after the code point, ignoring
+# CM and ZWJ as LB9 does. Returns 'Mandatory' for the breaks of LB4 and LB5.
+def lineBreakBetween(state, c, nuAhead):
+    prev, left, leftAfterHL, beforeSp, oddRI, number = state
+    rp = c[0]
+
+    if prev == 'BK':
+        return 'Mandatory'
+    if prev == 'CR' and rp == 'LF':
+        return False
+    if prev in ('CR', 'LF', 'NL'):
+        return 'Mandatory'
+    if rp in ('BK', 'CR', 'LF', 'NL'):
+        return False
+    if rp in ('SP', 'ZW'):
+        return False
+    if beforeSp == 'ZW':
+        return True
+    if prev == 'ZWJ':
+        return False
+    if rp in ('CM', 'ZWJ'):
+        if left[0] not in ('BK', 'CR', 'LF', 'NL', 'SP', 'ZW'):
+            return False
+        c = ('AL', False, False)
+        rp = c[0]
+
+    lp = left[0]
+    if rp == 'WJ' or lp == 'WJ':
+        return False
+    if lp == 'GL':
+        return False
+    if lp not in ('SP', 'BA', 'HY') and rp == 'GL':
+        return False
+    if rp in ('CL', 'CP', 'EX', 'IS', 'SY'):
+        return False
+    if beforeSp == 'OP':
+        return False
+    if beforeSp == 'QU' and rp == 'OP':
+        return False
+    if beforeSp in ('CL', 'CP') and rp == 'NS':
+        return False
+    if beforeSp == 'B2' and rp == 'B2':
+        return False
+    if lp == 'SP':
+        return True
+    if rp == 'QU' or lp == 'QU':
+        return False
+    if rp == 'CB' or lp == 'CB':
+        return True
+    if rp in ('BA', 'HY', 'NS') or lp == 'BB':
+        return False
+    if leftAfterHL and lp in ('HY', 'BA'):
+        return False
+    if lp == 'SY' and rp == 'HL':
+        return False
+    if rp == 'IN':
+        return False
+    if (lp in ('AL', 'HL') and rp == 'NU') or \
+       (lp == 'NU' and rp in ('AL', 'HL')):
+        return False
+    if (lp == 'PR' and rp in ('ID', 'EB', 'EM')) or \
+       (lp in ('ID', 'EB', 'EM') and rp == 'PO'):
+        return False
+    if (lp in ('PR', 'PO') and rp in ('AL', 'HL')) or \
+       (lp in ('AL', 'HL') and rp in ('PR', 'PO')):
+        return False
+    if lp in ('PR', 'PO') and \
+       (rp == 'NU' or (rp in ('OP', 'HY') and nuAhead)):
+        return False
+    if lp in ('OP', 'HY') and rp == 'NU':
+        return False
+    if number == 'NU' and rp in ('NU', 'SY', 'IS', 'CL', 'CP'):
+        return False
+    if number is not None and rp in ('PO', 'PR'):
+        return False
+    if (lp == 'JL' and rp in ('JL', 'JV', 'H2', 'H3')) or \
+       (lp in ('JV', 'H2') and rp in ('JV', 'JT')) or \
+       (lp in ('JT', 'H3') and rp == 'JT'):
+        return False
+    Korean = ('JL', 'JV', 'JT', 'H2', 'H3')
+    if (lp in Korean and rp == 'PO') or (lp == 'PR' and rp in Korean):
+        return False
+    if lp in ('AL', 'HL') and rp in ('AL', 'HL'):
+        return False
+    if lp == 'IS' and rp in ('AL', 'HL'):
+        return False
+    if (lp in ('AL', 'HL', 'NU') and rp == 'OP' and not c[1]) or \
+       (lp == 'CP' and not left[1] and rp in ('AL', 'HL', 'NU')):
+        return False
+    if lp == 'RI' and rp == 'RI' and oddRI:
+        return False
+    if (lp == 'EB' or left[2]) and rp == 'EM':
+        return False
+    return True
+
+def genLineBreakTable(ucd, out):
+    fout = open(out + '/_line_break_dfa.cpp', 'w')
+
+    classes = getLineClasses(ucd)[0]
+
+    # The previous code point if a rule looks at it alone, the class the text
+    # ends with after LB9 and LB10, whether HL comes before that one, the class
+    # before the spaces the text ends with if a rule looks at it, whether the
+    # text ends with an odd number of regional indicators, and whether it ends
+    # with 'NU (NU | SY | IS)*', 'NU', or that followed by CL or CP, 'Close'.
+    def advance(state, c):
+        prev, left, leftAfterHL, beforeSp, oddRI, number = state
+        rp = c[0]
+        if not rp in ('BK', 'CR', 'LF', 'NL', 'ZWJ'):
+            prev = None
+        else:
+            prev = rp
+        if rp in ('CM', 'ZWJ'):
+            if left is not None and \
+               left[0] not in ('BK', 'CR', 'LF', 'NL', 'SP', 'ZW'):
+                return (prev, left, leftAfterHL, beforeSp, oddRI, number)
+            c = ('AL', False, False)
+        leftAfterHL = left is not None and left[0] == 'HL'
+        if c[0] != 'SP':
+            beforeSp = c[0] if c[0] in ('ZW', 'OP', 'QU', 'CL', 'CP', 'B2') \
+                       else None
+        if c[0] == 'NU' or (c[0] in ('SY', 'IS') and number == 'NU'):
+            number = 'NU'
+        elif c[0] in ('CL', 'CP') and number == 'NU':
+            number = 'Close'
+        else:
+            number = None
+        return (prev, c, leftAfterHL, beforeSp,
+                c[0] == 'RI' and not oddRI, number)
+
+    # '(PR | PO) × (OP | HY) NU' of LB25 looks past OP and HY, to the next
+    # code point which isn't CM or ZWJ.
+    def decide(state, c):
+        if state[1] is None:
+            return True
+        results = set([lineBreakBetween(state, c, nuAhead)
+                       for nuAhead in (False, True)])
+        if len(results) == 1:
+            return results.pop()
+        def lookAhead(rp1):
+            if rp1 in ('CM', 'ZWJ'):
+                return LookAheadSkip
+            if lineBreakBetween(state, c, rp1 == 'NU'):
+                return LookAheadBreak
+            return LookAheadKeep
+        return tuple([lookAhead(p) for p, _, _ in classes] + [lookAhead(None)])
+
+    rows = buildBreakStateMachine(classes,
+                                  (None, None, False, None, False, None),
+                                  advance, decide)
+    lookAheadRows = []
+    for row in rows:
+        for decision, next in row:
+            if type(decision) == tuple and not decision in lookAheadRows:
+                lookAheadRows.append(decision)
+    assert len(rows) * len(classes) < 0x4000 and len(lookAheadRows) == 1
+
+    writeClasses(fout, classes,
+                 ('East_Asian', 'Unassigned Extended_Pictographic'))
+    fout.write("const size_t _line_break_dfa_class_count = %d;\n" % len(classes))
+    fout.write("const uint16_t _line_break_dfa[] = {\n")
+    for row in rows:
+        values = []
+        for decision, next in row:
+            if type(decision) == tuple:
+                flags = 0x4000
+            else:
+                flags = {False: 0, True: 0x8000, 'Mandatory': 0xC000}[decision]
+            values.append(flags | next * len(classes))
+        fout.write(''.join(["0x%04X," % v for v in values]) + "\n")
+    fout.write("};\n")
+    fout.write("const uint8_t _line_break_dfa_lookahead[] = {\n")
+    fout.write(''.join(["%d," % v for v in lookAheadRows[0]]) + "\n")
+    fout.write("};\n")
+
+#------------------------------------------------------------------------------
+# genPropertyRecordTable
+#------------------------------------------------------------------------------
+
+def genPropertyRecordTable(ucd, out):
+    fout = open(out + '/_property_records.cpp', 'w')
+
+    # Every combination of per code point properties that actually occurs is
+    # stored once as a record, and code points map to records through a trie.
+    columns = zip(getPropertyValues(ucd),
+                  getDerivedCorePropertyValues(ucd),
+                  getGeneralCategoryValues(ucd),
+                  getScriptValues(ucd),
+                  getGraphemeBreakValues(ucd),
+                  getWordBreakValues(ucd),
+                  getSentenceBreakValues(ucd),
+                  getEmojiValues(ucd),
+                  getCombiningClassValues(ucd),
+                  getQuickCheckValues(ucd),
+                  getGraphemeClassValues(ucd),
+                  getWordClassValues(ucd),
+                  getSentenceClassValues(ucd),
+                  getLineClassValues(ucd))
+
+    records = []
+    recordIds = {}
+    ids = []
+    for record in columns:
+        if not record in recordIds:
+            recordIds[record] = len(records)
+            records.append(record)
+        ids.append("%d" % recordIds[record])
+
+    writeTrie(fout, '_property_record_ids', 'uint16_t', ids)
+
+    fout.write("const PropertyRecord _property_records[] = {\n")
+    for record in records:
+        fout.write("{ 0x%016X, 0x%08X, "
+                   "static_cast<uint8_t>(GeneralCategory::%s), "
+                   "static_cast<uint8_t>(Script::%s), "
+                   "GraphemeBreak::%s, WordBreak::%s, SentenceBreak::%s, "
+                   "Emoji::%s, %d, 0x%02X, %d, %d, %d, %d },\n" % record)
     fout.write("};\n")
 
 #------------------------------------------------------------------------------
 # Main
 #------------------------------------------------------------------------------
 
+# LineBreak.txt and EastAsianWidth.txt are read from LINE_BREAK_DIR when it is
+# given. The copies in this tree are kept in test/linebreak rather than in UCD,
+# since they were not taken from the Unicode site.
+LineBreakDir = None
+
 if (len(sys.argv) < 3):
-    print('usage: python gen_tables.py UCD_DIR OUT_DIR')
+    print('usage: python gen_tables.py UCD_DIR OUT_DIR [LINE_BREAK_DIR]')
 else:
     ucd = sys.argv[1]
     out = sys.argv[2]
+    if len(sys.argv) > 3:
+        LineBreakDir = sys.argv[3]
 
-    genGeneralCategoryPropertyTable(ucd, out)
-    getPropertyTable(ucd, out)
-    getDerivedCorePropertyTable(ucd, out)
+    genPropertyRecordTable(ucd, out)
     getSimpleCaseMappingTable(ucd, out)
     getSpecialCaseMappingTable(ucd, out)
     getCaseFoldingTable(ucd, out)
     genBlockPropertyTable(ucd, out)
-    genScriptPropertyTable(ucd, out)
     genScriptExtensionIdTable(ucd, out)
     genScriptExtensionPropertyForIdTable(ucd, out)
     genNomalizationPropertyTable(ucd, out)
     genNomalizationCompositionTable(ucd, out)
-    getGraphemeBreakPropertyTable(ucd, out)
-    getWordBreakPropertyTable(ucd, out)
-    getSentenceBreakPropertyTable(ucd, out)
-    getEmojiPropertyTable(ucd, out)
+    genGraphemeBreakTable(ucd, out)
+    genWordBreakTable(ucd, out)
+    genSentenceBreakTable(ucd, out)
+    genLineBreakTable(ucd, out)